@@ -0,0 +1,183 @@
+// Scene-scaling benchmark: sweeps the procedural scenes in scenes.hpp over sphere counts and
+// records build time, memory per sphere and primary/bounce ray throughput for each.
+//
+// bench_scenes [max_count [csv_path [json_path]]]
+//
+// Sizes go 500, 1000, 2000, 5000, ... up to max_count (default 10M). Each size traces roughly
+// the same number of sphere-chunk tests, so big scenes get fewer rays rather than taking forever.
+
+#include "settings.hpp"
+
+#include "header.hpp"
+#include "hittable_list.hpp"
+#include "camera.hpp"
+#include "material.hpp"
+#include "scenes.hpp"
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+using Seconds = std::chrono::duration<double>;
+
+// Sphere-chunk tests to spend on each of the primary and bounce passes
+constexpr const double work_per_pass = 2e8;
+
+struct ScalingResult {
+    std::string generator;
+    int count;
+    double build_ms;
+    double bytes_per_primitive;
+    double allocated_bytes_per_primitive;
+    int primary_rays;
+    double primary_hit_fraction;
+    double primary_rays_per_s;
+    int bounce_rays;
+    double bounce_rays_per_s;
+};
+
+// Only the flat SIMD list exists for now; the column is there so other acceleration modes line up against it.
+constexpr const char* accel = "simd_list";
+
+// Bytes the list actually uses per sphere, padding of the last Vec8f included
+double bytes_per_primitive(const HittableList& world, int count) {
+    size_t bytes = (world.centreX.size() + world.centreY.size() + world.centreZ.size() + world.radius.size()) * sizeof(Vec8f)
+                 + world.mat.size() * sizeof(Material);
+    return double(bytes) / count;
+}
+
+// Same with the vectors' spare capacity, which jumps around as std::vector doubles
+double allocated_bytes_per_primitive(const HittableList& world, int count) {
+    size_t bytes = (world.centreX.capacity() + world.centreY.capacity() + world.centreZ.capacity() + world.radius.capacity()) * sizeof(Vec8f)
+                 + world.mat.capacity() * sizeof(Material);
+    return double(bytes) / count;
+}
+
+template <class Generator>
+ScalingResult measure(const std::string& name, int count, Generator generate) {
+    ScalingResult result{};
+    result.generator = name;
+    result.count = count;
+
+    time_point<Clock> start = Clock::now();
+    HittableList world = generate(count);
+    result.build_ms = Seconds(Clock::now() - start).count() * 1000;
+    result.bytes_per_primitive = bytes_per_primitive(world, count);
+    result.allocated_bytes_per_primitive = allocated_bytes_per_primitive(world, count);
+
+    // Look straight down so the image just covers the scene's square
+    float extent = scene_extent(count);
+    camera cam(point3(0, extent + 2, 0), point3(0, 0, 0), vec3(0, 0, -1), 2 * atanf(0.5f) * 180 / pi, 1, 0, 1);
+
+    int rays = (int)clamp(work_per_pass / world.radius.size(), 256., double(1 << 18));
+
+    std::vector<int> rayIterator;
+    for (int n = 0; n < rays; n++) {
+        rayIterator.push_back(n);
+    }
+
+    std::vector<ray> primary(rays);
+    std::vector<HitRecord> records(rays);
+    std::vector<char> hit(rays);
+
+    auto trace_primary = [&](int n) {
+        RNG rng{uint32_t(n)};
+        float u = random_float32(rng);
+        float v = random_float32(rng);
+        primary[n] = cam.get_ray(u, v, rng);
+        hit[n] = world.hit(primary[n], 1e-4, infinity, records[n]);
+    };
+
+    start = Clock::now();
+#ifdef MULTITHREAD
+    std::for_each(std::execution::par, rayIterator.begin(), rayIterator.end(), trace_primary);
+#else
+    std::for_each(rayIterator.begin(), rayIterator.end(), trace_primary);
+#endif
+    double primary_seconds = Seconds(Clock::now() - start).count();
+
+    result.primary_rays = rays;
+    result.primary_rays_per_s = rays / primary_seconds;
+
+    // A diffuse bounce off every primary hit, whatever its material, so all generators trace the same kind of ray
+    std::vector<int> bounceIterator;
+    for (int n = 0; n < rays; n++) {
+        if (hit[n]) bounceIterator.push_back(n);
+    }
+
+    auto trace_bounce = [&](int n) {
+        RNG rng{uint32_t(n) + 0x9E3779B9u};
+        vec3 direction = lambertian(records[n].normal, rng);
+        HitRecord rec;
+        hit[n] = world.hit(ray(records[n].p, direction), 1e-4, infinity, rec);
+    };
+
+    start = Clock::now();
+#ifdef MULTITHREAD
+    std::for_each(std::execution::par, bounceIterator.begin(), bounceIterator.end(), trace_bounce);
+#else
+    std::for_each(bounceIterator.begin(), bounceIterator.end(), trace_bounce);
+#endif
+    double bounce_seconds = Seconds(Clock::now() - start).count();
+
+    result.primary_hit_fraction = double(bounceIterator.size()) / rays;
+    result.bounce_rays = (int)bounceIterator.size();
+    result.bounce_rays_per_s = bounceIterator.empty() ? 0 : bounceIterator.size() / bounce_seconds;
+
+    return result;
+}
+
+int main(int argc, char** argv) {
+    int max_count = argc > 1 ? std::stoi(argv[1]) : 10'000'000;
+    std::string csv_path = argc > 2 ? argv[2] : "scaling.csv";
+    std::string json_path = argc > 3 ? argv[3] : "scaling.json";
+
+    std::vector<int> sizes;
+    for (int decade = 100; decade * 5 <= max_count; decade *= 10) {
+        for (int step : {5, 10, 20}) {
+            if (decade * step <= max_count) sizes.push_back(decade * step);
+        }
+    }
+
+    std::vector<ScalingResult> results;
+
+    auto report = [&](const ScalingResult& r) {
+        std::cout << r.generator << "\t" << r.count << "\tbuild " << r.build_ms << " ms\t" << r.bytes_per_primitive << " B/sphere\t"
+                  << r.primary_rays_per_s / 1e6 << " Mrays/s primary\t" << r.bounce_rays_per_s / 1e6 << " Mrays/s bounce\n" << std::flush;
+        results.push_back(r);
+    };
+
+    // The book scene, as a fixed reference point
+    report(measure("book", (int)random_scene().mat.size(), [](int) { return random_scene(); }));
+
+    for (int count : sizes) {
+        report(measure("grid", count, [](int n) { return grid_scene(n); }));
+        report(measure("clustered", count, [](int n) { return clustered_scene(n); }));
+        report(measure("overlapping", count, [](int n) { return overlapping_scene(n); }));
+        report(measure("mixed", count, [](int n) { return mixed_scene(n); }));
+    }
+
+    std::ofstream csv(csv_path);
+    csv << "generator,count,accel,build_ms,bytes_per_primitive,allocated_bytes_per_primitive,primary_rays,primary_hit_fraction,primary_rays_per_s,bounce_rays,bounce_rays_per_s\n";
+    for (const ScalingResult& r : results) {
+        csv << r.generator << ',' << r.count << ',' << accel << ',' << r.build_ms << ',' << r.bytes_per_primitive << ',' << r.allocated_bytes_per_primitive << ','
+            << r.primary_rays << ',' << r.primary_hit_fraction << ',' << r.primary_rays_per_s << ','
+            << r.bounce_rays << ',' << r.bounce_rays_per_s << '\n';
+    }
+
+    std::ofstream json(json_path);
+    json << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const ScalingResult& r = results[i];
+        json << "  {\"generator\": \"" << r.generator << "\", \"count\": " << r.count << ", \"accel\": \"" << accel << "\""
+             << ", \"build_ms\": " << r.build_ms << ", \"bytes_per_primitive\": " << r.bytes_per_primitive
+             << ", \"allocated_bytes_per_primitive\": " << r.allocated_bytes_per_primitive
+             << ", \"primary_rays\": " << r.primary_rays << ", \"primary_hit_fraction\": " << r.primary_hit_fraction
+             << ", \"primary_rays_per_s\": " << r.primary_rays_per_s
+             << ", \"bounce_rays\": " << r.bounce_rays << ", \"bounce_rays_per_s\": " << r.bounce_rays_per_s << "}"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    json << "]\n";
+
+    std::cout << "Wrote " << csv_path << " and " << json_path << "\n";
+}
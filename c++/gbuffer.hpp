@@ -0,0 +1,83 @@
+#pragma once
+
+#include "header.hpp"
+#include "camera.hpp"
+#include "hittable_list.hpp"
+
+#include <vector>
+
+// Primary hit of one camera sample. Enough to restart the path at the first bounce
+// without tracing the camera ray again, so materials can be edited between renders.
+struct PrimarySample {
+    ray r;
+    float t;
+    uint32_t id; // sphere index, or miss_id if the camera ray escaped
+    vec3 normal;
+    uint32_t seed; // RNG state right after the camera ray was generated
+
+    static constexpr uint32_t miss_id = 0xFFFFFFFF;
+};
+
+// FNV-1a, only used to notice when the cached hits no longer match the scene
+uint64_t hash_bytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Covers everything primary visibility depends on. Materials are deliberately left out.
+uint64_t gbuffer_key(const camera& cam, const HittableList& world, int image_width, int image_height, int samples_per_pixel) {
+    int dims[3] = {image_width, image_height, samples_per_pixel};
+
+    uint64_t hash = hash_bytes(dims, sizeof(dims));
+    hash = hash_bytes(&cam, sizeof(camera), hash);
+    hash = hash_bytes(world.centreX.data(), world.centreX.size() * sizeof(Vec8f), hash);
+    hash = hash_bytes(world.centreY.data(), world.centreY.size() * sizeof(Vec8f), hash);
+    hash = hash_bytes(world.centreZ.data(), world.centreZ.size() * sizeof(Vec8f), hash);
+    hash = hash_bytes(world.radius.data(), world.radius.size() * sizeof(Vec8f), hash);
+    return hash;
+}
+
+// One PrimarySample per pixel sample (48 bytes each), so this is meant for previews, not the Claforte preset.
+class GBuffer {
+public:
+    uint64_t key;
+    int image_width;
+    int samples_per_pixel;
+    std::vector<PrimarySample> samples;
+
+    GBuffer(uint64_t key, int image_width, int image_height, int samples_per_pixel)
+        : key(key), image_width(image_width), samples_per_pixel(samples_per_pixel),
+          samples(size_t(image_width) * image_height * samples_per_pixel) {}
+
+    PrimarySample& at(int i, int j, int s) {
+        return samples[(size_t(j) * image_width + i) * samples_per_pixel + s];
+    }
+
+    // Returns false if there is no cache or it was made for a different camera/scene. A truncated file can leave
+    // the buffer half filled, which is fine as the caller then traces every sample again.
+    bool load(const char* path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+
+        uint64_t file_key = 0, count = 0;
+        in.read(reinterpret_cast<char*>(&file_key), sizeof(file_key));
+        in.read(reinterpret_cast<char*>(&count), sizeof(count));
+        if (!in || file_key != key || count != samples.size()) return false;
+
+        // Straight into the buffer; a second copy would double peak memory on a cache hit
+        in.read(reinterpret_cast<char*>(samples.data()), count * sizeof(PrimarySample));
+        return bool(in);
+    }
+
+    void save(const char* path) const {
+        std::ofstream out(path, std::ios::binary);
+        uint64_t count = samples.size();
+        out.write(reinterpret_cast<const char*>(&key), sizeof(key));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.write(reinterpret_cast<const char*>(samples.data()), count * sizeof(PrimarySample));
+    }
+};
@@ -8,12 +8,15 @@
 #include <chrono>
 #include <algorithm>
 #include <execution>
+#include <thread>
 #include <exception>
 
 #ifdef _WIN32
 #include <windows.h>
+#include <psapi.h>
 #else
 #include <unistd.h>
+#include <sys/resource.h>
 #endif
 
 // Usings
@@ -40,6 +43,23 @@ constexpr inline float degrees_to_radians(float degrees) {
     return degrees * pi / 180;
 }
 
+// Peak resident set size of this process so far, in bytes
+size_t peak_rss_bytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss; // already bytes on macOS
+#else
+    return size_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
 class RNG {
 public:
     uint32_t seed;
@@ -65,6 +85,11 @@ inline float random_float32(RNG& rng) {
     return bit_cast<float>((random_uint32(rng) & 0x007FFFFF) | 0x3f800000) - 1;
 }
 
+// Returns a random real in [lo, hi).
+inline float random_float32(RNG& rng, float lo, float hi) {
+    return lo + (hi - lo) * random_float32(rng);
+}
+
 // random float in [-1, 1)
 float random_float32_minustoplus(RNG& rng) {
     return bit_cast<float>((random_uint32(rng) & 0x007FFFFF) | 0x40000000) - 3;
@@ -14,11 +14,15 @@ struct HitRecord {
     vec3 p;
     vec3 normal;
     Material mat;
+    uint32_t id; // index of the hit sphere, used to look its material back up
 };
 
 class HittableList
 {
 public:
+    // Most rays the batched hit() takes at once
+    static constexpr int max_batch = 8;
+
     std::vector<Vec8f> centreX;
     std::vector<Vec8f> centreY;
     std::vector<Vec8f> centreZ;
@@ -104,10 +108,85 @@ public:
         }
 
         // now we have up to n hits, find and return closest one
+        hit_anything = closest_hit(r, hitT, id, t_max, rec);
+
+        return hit_anything;
+    }
+
+    // Same as hit() for n <= max_batch rays at once, e.g. one pixel seen from several cameras.
+    // Each chunk of spheres is loaded once and tested against every ray before moving on.
+    void hit(const ray *rays, int n, float t_min, float t_max, HitRecord *recs, bool *hits) const
+    {
+        Vec8f hitT[max_batch];
+        Vec8ui id[max_batch];
+
+        Vec8f rOrigX[max_batch], rOrigY[max_batch], rOrigZ[max_batch];
+        Vec8f rDirX[max_batch], rDirY[max_batch], rDirZ[max_batch];
+
+        for (int k = 0; k < n; k++)
+        {
+            hitT[k] = Vec8f(t_max);
+            id[k] = Vec8ui(0);
+
+            rOrigX[k] = Vec8f(rays[k].origin.x);
+            rOrigY[k] = Vec8f(rays[k].origin.y);
+            rOrigZ[k] = Vec8f(rays[k].origin.z);
+            rDirX[k] = Vec8f(rays[k].direction.x);
+            rDirY[k] = Vec8f(rays[k].direction.y);
+            rDirZ[k] = Vec8f(rays[k].direction.z);
+        }
+
+        Vec8f tMinVec(t_min);
+        Vec8ui curId(0, 1, 2, 3, 4, 5, 6, 7);
+
+        for (int i = 0; i < (int)radius.size(); i++)
+        {
+            Vec8f cX = centreX[i];
+            Vec8f cY = centreY[i];
+            Vec8f cZ = centreZ[i];
+            Vec8f radiusSquared = radius[i] * radius[i];
+
+            for (int k = 0; k < n; k++)
+            {
+                Vec8f coX = cX - rOrigX[k];
+                Vec8f coY = cY - rOrigY[k];
+                Vec8f coZ = cZ - rOrigZ[k];
+
+                Vec8f neg_half_b = coX * rDirX[k] + coY * rDirY[k] + coZ * rDirZ[k];
+                Vec8f c = coX * coX + coY * coY + coZ * coZ - radiusSquared;
+                Vec8f quarter_discriminant = neg_half_b * neg_half_b - c;
+                Vec8fb isDiscriminantPositive = quarter_discriminant > Vec8f(0.0f);
+
+                if (horizontal_or(isDiscriminantPositive))
+                {
+                    Vec8f quarter_discriminant_root = sqrt(quarter_discriminant);
+
+                    Vec8f t0 = neg_half_b - quarter_discriminant_root;
+                    Vec8f t1 = neg_half_b + quarter_discriminant_root;
+
+                    Vec8f t = select(t0 > tMinVec, t0, t1);
+                    Vec8fb msk = isDiscriminantPositive & (tMinVec < t) & (t < hitT[k]);
+
+                    id[k] = select((Vec8ib)msk, curId, id[k]);
+                    hitT[k] = select(msk, t, hitT[k]);
+                }
+            }
+            curId += Vec8ui(Vec8f::size());
+        }
+
+        for (int k = 0; k < n; k++)
+        {
+            hits[k] = closest_hit(rays[k], hitT[k], id[k], t_max, recs[k]);
+        }
+    }
+
+private:
+    // Reduces the per-lane closest hits of one ray and fills in rec if there was one
+    bool closest_hit(const ray &r, Vec8f hitT, Vec8ui id, float t_max, HitRecord &rec) const
+    {
         float minT = horizontal_min(hitT);
-        hit_anything = minT < t_max;
 
-        if (hit_anything)
+        if (minT < t_max)
         { // did we hit anything?
             int lane = horizontal_find_first(hitT == Vec8f(minT));
             int hitId = id[lane];
@@ -120,8 +199,10 @@ public:
             rec.p = r.at(rec.t);
             rec.normal = (rec.p - vec3(centreX[i][j], centreY[i][j], centreZ[i][j])) / radius[i][j];
             rec.mat = mat[hitId];
+            rec.id = hitId;
+            return true;
         }
 
-        return hit_anything;
+        return false;
     }
 };
\ No newline at end of file
@@ -8,6 +8,22 @@
 #include "sphere.hpp"
 #include "camera.hpp"
 #include "material.hpp"
+#include "scenes.hpp"
+
+#ifdef GBUFFER_CACHE
+#include "gbuffer.hpp"
+#endif
+
+#if defined(MULTIVIEW) && (defined(GBUFFER_CACHE) || defined(STREAM_TILES))
+#error "MULTIVIEW renders whole images per view and does not use GBUFFER_CACHE or STREAM_TILES"
+#endif
+
+#ifdef STREAM_TILES
+#ifdef GBUFFER_CACHE
+#error "GBUFFER_CACHE keeps every sample of the image in memory, which defeats STREAM_TILES"
+#endif
+#include "stream.hpp"
+#endif
 
 colour world_colour(ray r) {
     vec3 unit_direction = r.direction;
@@ -15,103 +31,328 @@ colour world_colour(ray r) {
     return (1 - t) * colour(1, 1, 1) + t * colour(0.5, 0.7, 1);
 }
 
-colour ray_colour(ray r, const HittableList& world, int depth, RNG& rng) {
+// Continues a path whose first hit, rec, has already been found for r.
+colour ray_colour_from_hit(ray r, HitRecord rec, const HittableList& world, int depth, RNG& rng) {
     colour accumulated_attenuation(1, 1, 1);
 
+    for (int bounces = 1; ; bounces++) {
+        auto [direction, attenuation, scatter_again] = rec.mat.scatter(r, rec.normal, rng);
+        if (!scatter_again) {
+            return colour(0, 0, 0);
+        }
+        accumulated_attenuation *= attenuation;
+        r = {rec.p, direction};
+
+        // If we've exceeded the ray bounce limit, no more light is gathered.
+        if (bounces >= depth) {
+            return colour(0, 0, 0);
+        }
+
+        if (!world.hit(r, 1e-4, infinity, rec)) {
+            return accumulated_attenuation * world_colour(r);
+        }
+    }
+}
+
+colour ray_colour(ray r, const HittableList& world, int depth, RNG& rng) {
     HitRecord rec;
 
-    for (int bounces = 0; bounces < depth; bounces++) {
-        if (world.hit(r, 1e-4, infinity, rec)) {
-            auto [direction, attenuation, scatter_again] = rec.mat.scatter(r, rec.normal, rng);
+    if (depth <= 0) {
+        return colour(0, 0, 0);
+    }
+
+    if (!world.hit(r, 1e-4, infinity, rec)) {
+        return world_colour(r);
+    }
+
+    return ray_colour_from_hit(r, rec, world, depth, rng);
+}
+
+#ifdef MULTIVIEW
+// Traces n paths in lockstep, so every bounce is a single batched traversal of the world for all of them.
+// The paths draw from one RNG stream in turn, so each colour is a different sample than ray_colour would
+// give for that ray; they only agree in expectation.
+void ray_colour_batch(ray* rays, int n, const HittableList& world, int depth, RNG& rng, colour* out) {
+    colour accumulated_attenuation[HittableList::max_batch];
+    int active[HittableList::max_batch];
+    int active_count = n;
+
+    for (int k = 0; k < n; k++) {
+        accumulated_attenuation[k] = colour(1, 1, 1);
+        out[k] = colour(0, 0, 0);
+        active[k] = k;
+    }
+
+    ray batch[HittableList::max_batch];
+    HitRecord recs[HittableList::max_batch];
+    bool hits[HittableList::max_batch];
+
+    for (int bounces = 0; bounces < depth && active_count > 0; bounces++) {
+        for (int a = 0; a < active_count; a++) {
+            batch[a] = rays[active[a]];
+        }
+
+        world.hit(batch, active_count, 1e-4, infinity, recs, hits);
+
+        int still_active = 0;
+        for (int a = 0; a < active_count; a++) {
+            int k = active[a];
+
+            if (!hits[a]) {
+                out[k] = accumulated_attenuation[k] * world_colour(rays[k]);
+                continue;
+            }
+
+            auto [direction, attenuation, scatter_again] = recs[a].mat.scatter(rays[k], recs[a].normal, rng);
             if (scatter_again) {
-                accumulated_attenuation *= attenuation;
-                r = {rec.p, direction};
-            } else {
-                return colour(0, 0, 0);
+                accumulated_attenuation[k] *= attenuation;
+                rays[k] = {recs[a].p, direction};
+                active[still_active++] = k;
             }
         }
-        else {
-            return accumulated_attenuation * world_colour(r);
-        }
+        active_count = still_active;
     }
 
-    // If we've exceeded the ray bounce limit, no more light is gathered.
-    return colour(0, 0, 0);
+    // Paths still active have exceeded the ray bounce limit and gather no light.
 }
 
-HittableList random_scene() {
-    HittableList world;
-    RNG rng{0};
+// Renders every view in one pass over shared tiles: each tile is done for all views at once and the
+// views' rays for a sample go through the world together, HittableList::max_batch views at a time.
+// Then renders the views one after another the usual way, to compare throughput.
+// Writes image_view<k>.ppm for each view.
+void render_multiview(const std::vector<camera>& views, const HittableList& world, int image_width, int image_height, int samples_per_pixel, int max_depth) {
+    const int tile_size = 16;
+    const int view_count = (int)views.size();
+
+    std::vector<std::vector<colour>> images(view_count, std::vector<colour>(size_t(image_width) * image_height, colour(0, 0, 0)));
+
+    std::vector<int> tileIterator;
+    const int tiles_across = (image_width + tile_size - 1) / tile_size;
+    const int tiles_down = (image_height + tile_size - 1) / tile_size;
+    for (int t = 0; t < tiles_across * tiles_down; ++t) {
+        tileIterator.push_back(t);
+    }
 
-    world.add(Sphere(point3(0, -1000, 0), 1000, Material::Lambertian(colour(0.5, 0.5, 0.5))));
+    auto for_each_pixel = [&](int t, auto&& shade) {
+        int i0 = (t % tiles_across) * tile_size;
+        int j0 = (t / tiles_across) * tile_size;
 
-    for (int a = -11; a < 11; a++) {
-        for (int b = -11; b < 11; b++) {
-            float choose_mat = random_float32(rng);
-            point3 center(a + 0.9f * random_float32(rng), 0.2, b + 0.9f * random_float32(rng));
+        for (int j = j0; j < min(j0 + tile_size, image_height); ++j) {
+            for (int i = i0; i < min(i0 + tile_size, image_width); ++i) {
+                shade(i, j);
+            }
+        }
+    };
 
-            if (length(center - point3(4, 0.2, 0)) > 0.9f) {
-                if (choose_mat < 0.8f) {
-                    // diffuse
-                    colour albedo = colour::random(rng) * colour::random(rng);
-                    world.add(Sphere(center, 0.2, Material::Lambertian(albedo)));
-                }
-                else if (choose_mat < 0.95f) {
-                    // metal
-                    colour albedo = colour::random(rng) / 2 + vec3(.5);
-                    float fuzz = random_float32(rng) / 2;
-                    world.add(Sphere(center, 0.2, Material::Metal(albedo, fuzz)));
-                }
-                else {
-                    // glass
-                    world.add(Sphere(center, 0.2, Material::Dielectric()));
+    auto render_tile_batched = [&](int t) {
+        thread_local RNG rng{124309};
+
+        for_each_pixel(t, [&](int i, int j) {
+            ray rays[HittableList::max_batch];
+            colour colours[HittableList::max_batch];
+
+            for (int s = 0; s < samples_per_pixel; ++s) {
+                float u = ((float)i + random_float32(rng)) / (image_width - 1);
+                float v = ((float)j + random_float32(rng)) / (image_height - 1);
+
+                for (int first = 0; first < view_count; first += HittableList::max_batch) {
+                    int n = min(HittableList::max_batch, view_count - first);
+
+                    for (int k = 0; k < n; ++k) {
+                        rays[k] = views[first + k].get_ray(u, v, rng);
+                    }
+
+                    ray_colour_batch(rays, n, world, max_depth, rng, colours);
+
+                    for (int k = 0; k < n; ++k) {
+                        images[first + k][size_t(j) * image_width + i] += colours[k];
+                    }
                 }
             }
+        });
+    };
+
+    // Untimed, so the batched pass, which goes first, does not also pay for starting the
+    // thread pool and pulling the world into cache
+    auto warm_up = [&](int t) {
+        thread_local RNG rng{124309};
+        HitRecord rec;
+        world.hit(views[t % view_count].get_ray(0.5f, 0.5f, rng), 1e-4, infinity, rec);
+    };
+#ifdef MULTITHREAD
+    std::for_each(std::execution::par, tileIterator.begin(), tileIterator.end(), warm_up);
+#else
+    std::for_each(tileIterator.begin(), tileIterator.end(), warm_up);
+#endif
+
+    time_point<Clock> start_time = Clock::now();
+#ifdef MULTITHREAD
+    std::for_each(std::execution::par, tileIterator.begin(), tileIterator.end(), render_tile_batched);
+#else
+    std::for_each(tileIterator.begin(), tileIterator.end(), render_tile_batched);
+#endif
+    float batched_seconds = duration_cast<milliseconds>(Clock::now() - start_time).count() / 1000.f;
+
+    for (int k = 0; k < view_count; ++k) {
+        std::ofstream myfile("image_view" + std::to_string(k) + ".ppm");
+        myfile << "P3\n" << image_width << " " << image_height << "\n255\n";
+
+        for (int j = image_height - 1; j >= 0; --j) {
+            for (int i = 0; i < image_width; ++i) {
+                write_colour(myfile, images[k][size_t(j) * image_width + i], samples_per_pixel);
+            }
         }
     }
 
-    world.add(Sphere(point3(0, 1, 0), 1.0, Material::Dielectric()));
+    // The same work one view at a time, as separate runs would do it
+    std::vector<std::vector<colour>> sequential_images(view_count, std::vector<colour>(size_t(image_width) * image_height, colour(0, 0, 0)));
+
+    auto mean = [&](const std::vector<colour>& pixels) {
+        double sum = 0;
+        for (const colour& c : pixels) {
+            sum += c.x + c.y + c.z;
+        }
+        return float(sum / (3.0 * pixels.size() * samples_per_pixel));
+    };
+
+    start_time = Clock::now();
+    for (int k = 0; k < view_count; ++k) {
+        const camera& cam = views[k];
+        std::vector<colour>& image = sequential_images[k];
 
-    world.add(Sphere(point3(-4, 1, 0), 1.0, Material::Lambertian({0.4, 0.2, 0.1})));
+        auto render_tile = [&](int t) {
+            thread_local RNG rng{124309};
 
-    world.add(Sphere(point3(4, 1, 0), 1.0, Material::Metal({0.7, 0.6, 0.5}, 0)));
+            for_each_pixel(t, [&](int i, int j) {
+                for (int s = 0; s < samples_per_pixel; ++s) {
+                    float u = ((float)i + random_float32(rng)) / (image_width - 1);
+                    float v = ((float)j + random_float32(rng)) / (image_height - 1);
 
-    return world;
+                    image[size_t(j) * image_width + i] += ray_colour(cam.get_ray(u, v, rng), world, max_depth, rng);
+                }
+            });
+        };
+
+#ifdef MULTITHREAD
+        std::for_each(std::execution::par, tileIterator.begin(), tileIterator.end(), render_tile);
+#else
+        std::for_each(tileIterator.begin(), tileIterator.end(), render_tile);
+#endif
+    }
+    float sequential_seconds = duration_cast<milliseconds>(Clock::now() - start_time).count() / 1000.f;
+
+    float samples = float(image_width) * image_height * samples_per_pixel * view_count;
+
+    std::cout << view_count << " views, batched: " << batched_seconds << " s, " << samples / batched_seconds / 1e6f << " Msamples/s\n"
+              << view_count << " views, sequential: " << sequential_seconds << " s, " << samples / sequential_seconds / 1e6f << " Msamples/s\n"
+              << "Speedup " << sequential_seconds / batched_seconds << "x\n";
+
+    // A quick check that batching did not change the images beyond noise
+    for (int k = 0; k < view_count; ++k) {
+        std::cout << "View " << k << " mean: batched " << mean(images[k]) << ", sequential " << mean(sequential_images[k]) << "\n";
+    }
 }
+#endif
+
+#ifdef GBUFFER_CACHE
+// Same as ray_colour but also records the primary hit into sample.
+colour ray_colour_recording(ray r, const HittableList& world, int depth, RNG& rng, PrimarySample& sample) {
+    HitRecord rec;
+
+    sample.r = r;
+    sample.seed = rng.seed;
+    sample.id = PrimarySample::miss_id;
+
+    // The hit is recorded whatever the depth, as max_depth is not part of the cache key
+    bool hit = world.hit(r, 1e-4, infinity, rec);
+    if (hit) {
+        sample.t = rec.t;
+        sample.id = rec.id;
+        sample.normal = rec.normal;
+    }
+
+    if (depth <= 0) {
+        return colour(0, 0, 0);
+    }
 
-int main() {
+    if (!hit) {
+        return world_colour(r);
+    }
+
+    return ray_colour_from_hit(r, rec, world, depth, rng);
+}
+
+// Restarts the path from a cached primary hit using the world's current materials.
+colour ray_colour_cached(const PrimarySample& sample, const HittableList& world, int depth) {
+    if (depth <= 0) {
+        return colour(0, 0, 0);
+    }
+
+    if (sample.id == PrimarySample::miss_id) {
+        return world_colour(sample.r);
+    }
+
+    HitRecord rec;
+    rec.t = sample.t;
+    rec.p = sample.r.at(sample.t);
+    rec.normal = sample.normal;
+    rec.mat = world.mat[sample.id];
+    rec.id = sample.id;
+
+    // Restoring the RNG makes a re-shade with unchanged materials match the original render.
+    RNG rng{sample.seed};
+    return ray_colour_from_hit(sample.r, rec, world, depth, rng);
+}
+#endif
+
+int main(int argc, char** argv) {
     // IMAGE
 
 #ifdef PROFVIEW
     const float aspect_ratio = 16.f / 9;
-    const int image_width = 1920 / 2;
-    const int image_height = static_cast<int>(image_width / aspect_ratio);
-    const int samples_per_pixel = 10;
-    const int max_depth = 16;
+    int image_width = 1920 / 2;
+    int image_height = static_cast<int>(image_width / aspect_ratio);
+    int samples_per_pixel = 10;
+    int max_depth = 16;
 #else
 #ifdef CLAFORTE
     const float aspect_ratio = 16.f / 9;
-    const int image_width = 1920;
-    const int image_height = static_cast<int>(image_width / aspect_ratio);
-    const int samples_per_pixel = 1000;
-    const int max_depth = 16;
+    int image_width = 1920;
+    int image_height = static_cast<int>(image_width / aspect_ratio);
+    int samples_per_pixel = 1000;
+    int max_depth = 16;
 #else
 #if 1
     const float aspect_ratio = 16.f / 9;
-    const int image_width = 400;
-    constexpr const int image_height = static_cast<int>(image_width / aspect_ratio);
-    const int samples_per_pixel = 5;
-    const int max_depth = 5;
+    int image_width = 400;
+    int image_height = static_cast<int>(image_width / aspect_ratio);
+    int samples_per_pixel = 5;
+    int max_depth = 5;
 #else
     const float aspect_ratio = 16.f / 9;
-    const int image_width = 800;
-    const int image_height = static_cast<int>(image_width / aspect_ratio);
-    const int samples_per_pixel = 50;
-    const int max_depth = 10;
+    int image_width = 800;
+    int image_height = static_cast<int>(image_width / aspect_ratio);
+    int samples_per_pixel = 50;
+    int max_depth = 10;
 #endif
 #endif
 #endif
 
+    // main [width samples_per_pixel max_depth [image.ppm [scene.txt]]] overrides the preset above,
+    // which is how benchmark/parity.jl drives it. scene.txt gets the scene and camera in the
+    // text format the Julia and Rust renderers load.
+    const char* image_path = "image.ppm";
+
+    if (argc > 3) {
+        image_width = std::atoi(argv[1]);
+        image_height = static_cast<int>(image_width / aspect_ratio);
+        samples_per_pixel = std::atoi(argv[2]);
+        max_depth = std::atoi(argv[3]);
+    }
+    if (argc > 4) {
+        image_path = argv[4];
+    }
+
     // WORLD
     HittableList world = random_scene();
 
@@ -122,16 +363,77 @@ int main() {
     vec3 vup(0, 1, 0);
     float dist_to_focus = 10;
     float aperture = 0.1;
+    float vfov = 20;
 
-    camera cam(lookfrom, lookat, vup, 20, aspect_ratio, aperture, dist_to_focus);
+    camera cam(lookfrom, lookat, vup, vfov, aspect_ratio, aperture, dist_to_focus);
+
+    if (argc > 5) {
+        write_scene(argv[5], world, lookfrom, lookat, vup, vfov, aspect_ratio, aperture, dist_to_focus);
+    }
+
+#ifdef MULTIVIEW
+#ifdef MULTIVIEW_SPHERES
+    // Same cameras, but a world far bigger than the cache, which is where batching the views pays off
+    world = grid_scene(MULTIVIEW_SPHERES);
+#endif
+
+    // A stereo pair, then product shots orbiting 30 degrees further out on alternate sides
+    auto orbit = [&](float degrees) {
+        float angle = degrees_to_radians(degrees);
+        return point3(cosf(angle) * lookfrom.x - sinf(angle) * lookfrom.z, lookfrom.y, sinf(angle) * lookfrom.x + cosf(angle) * lookfrom.z);
+    };
+    vec3 eye_offset = 0.2f * normalised(cross(lookat - lookfrom, vup));
+
+    std::vector<camera> views = {
+        cam,
+        camera(lookfrom + eye_offset, lookat, vup, vfov, aspect_ratio, aperture, dist_to_focus)
+    };
+    for (int k = 0; (int)views.size() < MULTIVIEW; ++k) {
+        float degrees = 30.f * (k / 2 + 1) * (k % 2 ? -1 : 1);
+        views.push_back(camera(orbit(degrees), lookat, vup, vfov, aspect_ratio, aperture, dist_to_focus));
+    }
+
+    render_multiview(views, world, image_width, image_height, samples_per_pixel, max_depth);
+    return 0;
+#endif
+
+#ifdef GBUFFER_CACHE
+    // Primary hits are reused across runs until the camera, geometry or resolution changes,
+    // so material tweaks only pay for the bounces.
+    GBuffer gbuffer(gbuffer_key(cam, world, image_width, image_height, samples_per_pixel), image_width, image_height, samples_per_pixel);
+    const bool reshade = gbuffer.load(GBUFFER_CACHE);
+
+    std::cout << (reshade ? "Re-shading from cached primary hits\n" : "Primary hit cache missing or stale, tracing from the camera\n");
+#endif
+
+    auto render_sample = [&](int i, int j, [[maybe_unused]] int s, RNG& rng) -> colour {
+#ifdef GBUFFER_CACHE
+        if (reshade) {
+            return ray_colour_cached(gbuffer.at(i, j, s), world, max_depth);
+        }
+#endif
+        float u = ((float)i + random_float32(rng)) / (image_width - 1);
+        float v = ((float)j + random_float32(rng)) / (image_height - 1);
+
+        ray r = cam.get_ray(u, v, rng);
+
+#ifdef GBUFFER_CACHE
+        return ray_colour_recording(r, world, max_depth, rng, gbuffer.at(i, j, s));
+#else
+        return ray_colour(r, world, max_depth, rng);
+#endif
+    };
 
     // Render
 
     std::ofstream myfile;
-    myfile.open("image.ppm");
+    myfile.open(image_path);
 
     myfile << "P3\n" << image_width << " " << image_height << "\n255\n";
 
+#ifdef STREAM_TILES
+    render_streaming(myfile, image_width, image_height, samples_per_pixel, STREAM_TILES, render_sample);
+#else
     std::vector<std::vector<colour>> pixel(image_height, std::vector<colour>(image_width, colour(0, 0, 0)));
 
     // This is pretty big for the stack, I doubt there's any performance improvement also
@@ -157,12 +459,7 @@ int main() {
                 colour& pixel_colour = pixel[j][i];
 
                 for (int s = 0; s < samples_per_pixel; ++s) {
-                    float u = ((float)i + random_float32(rng)) / (image_width - 1);
-                    float v = ((float)j + random_float32(rng)) / (image_height - 1);
-
-                    ray r = cam.get_ray(u, v, rng);
-
-                    pixel_colour += ray_colour(r, world, max_depth, rng);
+                    pixel_colour += render_sample(i, j, s, rng);
                 }
             }
         });
@@ -175,22 +472,31 @@ int main() {
             colour& pixel_colour = pixel[j][i];
 
             for (int s = 0; s < samples_per_pixel; ++s) {
-                auto u = float(i + random_float32(rng)) / (image_width - 1);
-                auto v = float(j + random_float32(rng)) / (image_height - 1);
-
-                ray r = cam.get_ray(u, v, rng);
-
-                pixel_colour += ray_colour(r, world, max_depth, rng);
+                pixel_colour += render_sample(i, j, s, rng);
             }
         }
     }
 #endif
 
     std::cout << "\nDone in " << duration_cast<milliseconds>(Clock::now() - start_time).count() << " milliseconds\n";
+#ifdef MULTITHREAD
+    std::cout << "Threads " << std::thread::hardware_concurrency() << "\n";
+#else
+    std::cout << "Threads 1\n";
+#endif
+
+#ifdef GBUFFER_CACHE
+    if (!reshade) {
+        gbuffer.save(GBUFFER_CACHE);
+    }
+#endif
 
     for (int j = image_height - 1; j >= 0; --j) {
         for (int i = 0; i < image_width; ++i) {
             write_colour(myfile, pixel[j][i], samples_per_pixel);
         }
     }
+
+    std::cout << "Peak RSS " << peak_rss_bytes() / (1024 * 1024) << " MiB\n";
+#endif
 }
\ No newline at end of file
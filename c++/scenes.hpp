@@ -0,0 +1,166 @@
+#pragma once
+
+#include "header.hpp"
+#include "hittable_list.hpp"
+#include "sphere.hpp"
+#include "material.hpp"
+
+#include <vector>
+
+// The book's final scene, about 480 spheres.
+HittableList random_scene() {
+    HittableList world;
+    RNG rng{0};
+
+    world.add(Sphere(point3(0, -1000, 0), 1000, Material::Lambertian(colour(0.5, 0.5, 0.5))));
+
+    for (int a = -11; a < 11; a++) {
+        for (int b = -11; b < 11; b++) {
+            float choose_mat = random_float32(rng);
+            point3 center(a + 0.9f * random_float32(rng), 0.2, b + 0.9f * random_float32(rng));
+
+            if (length(center - point3(4, 0.2, 0)) > 0.9f) {
+                if (choose_mat < 0.8f) {
+                    // diffuse
+                    colour albedo = colour::random(rng) * colour::random(rng);
+                    world.add(Sphere(center, 0.2, Material::Lambertian(albedo)));
+                }
+                else if (choose_mat < 0.95f) {
+                    // metal
+                    colour albedo = colour::random(rng) / 2 + vec3(.5);
+                    float fuzz = random_float32(rng) / 2;
+                    world.add(Sphere(center, 0.2, Material::Metal(albedo, fuzz)));
+                }
+                else {
+                    // glass
+                    world.add(Sphere(center, 0.2, Material::Dielectric()));
+                }
+            }
+        }
+    }
+
+    world.add(Sphere(point3(0, 1, 0), 1.0, Material::Dielectric()));
+
+    world.add(Sphere(point3(-4, 1, 0), 1.0, Material::Lambertian({0.4, 0.2, 0.1})));
+
+    world.add(Sphere(point3(4, 1, 0), 1.0, Material::Metal({0.7, 0.6, 0.5}, 0)));
+
+    return world;
+}
+
+// Procedural scenes for scaling measurements. Each places exactly count spheres, at about
+// one per unit area, on a square of side scene_extent(count) centred on the origin, so ray
+// statistics stay comparable between sizes. The same seed always gives the same scene.
+
+float scene_extent(int count) {
+    return ceilf(sqrtf((float)count));
+}
+
+// Regular grid of small jittered diffuse spheres
+HittableList grid_scene(int count, uint32_t seed = 1) {
+    HittableList world;
+    RNG rng{seed};
+
+    int side = (int)scene_extent(count);
+    float half = side / 2.f;
+
+    for (int n = 0; n < count; n++) {
+        point3 centre((n % side) - half + 0.5f + random_float32(rng, -0.25, 0.25), 0.3, (n / side) - half + 0.5f + random_float32(rng, -0.25, 0.25));
+        world.add(Sphere(centre, random_float32(rng, 0.2, 0.3), Material::Lambertian(colour::random(rng) * colour::random(rng))));
+    }
+
+    return world;
+}
+
+// Dense blobs of small spheres with empty space between them, roughly 2000 spheres per blob
+HittableList clustered_scene(int count, uint32_t seed = 2) {
+    HittableList world;
+    RNG rng{seed};
+
+    float half = scene_extent(count) / 2;
+    int clusters = max(1, count / 2000);
+    float spread = half / sqrtf((float)clusters) * 0.5f;
+
+    std::vector<point3> centres;
+    for (int c = 0; c < clusters; c++) {
+        centres.push_back(point3(random_float32(rng, spread - half, half - spread), spread, random_float32(rng, spread - half, half - spread)));
+    }
+
+    for (int n = 0; n < count; n++) {
+        // Sum of three uniforms, a cheap bell shape around the cluster centre
+        vec3 offset = vec3::random_minustoplus(rng) + vec3::random_minustoplus(rng) + vec3::random_minustoplus(rng);
+        point3 centre = centres[n % clusters] + spread / 3 * offset;
+        world.add(Sphere(centre, random_float32(rng, 0.1, 0.3), Material::Lambertian(colour::random(rng) * colour::random(rng))));
+    }
+
+    return world;
+}
+
+// Large spheres at the same density, so each one overlaps dozens of its neighbours
+HittableList overlapping_scene(int count, uint32_t seed = 3) {
+    HittableList world;
+    RNG rng{seed};
+
+    float half = scene_extent(count) / 2;
+
+    for (int n = 0; n < count; n++) {
+        point3 centre(random_float32(rng, -half, half), random_float32(rng, 0, 2), random_float32(rng, -half, half));
+        world.add(Sphere(centre, random_float32(rng, 1, 3), Material::Lambertian(colour::random(rng) * colour::random(rng))));
+    }
+
+    return world;
+}
+
+// The grid layout with the book's mix of diffuse, metal and glass
+HittableList mixed_scene(int count, uint32_t seed = 4) {
+    HittableList world;
+    RNG rng{seed};
+
+    int side = (int)scene_extent(count);
+    float half = side / 2.f;
+
+    for (int n = 0; n < count; n++) {
+        point3 centre((n % side) - half + 0.5f + random_float32(rng, -0.25, 0.25), 0.3, (n / side) - half + 0.5f + random_float32(rng, -0.25, 0.25));
+        float radius = random_float32(rng, 0.2, 0.3);
+        float choose_mat = random_float32(rng);
+
+        if (choose_mat < 0.8f) {
+            world.add(Sphere(centre, radius, Material::Lambertian(colour::random(rng) * colour::random(rng))));
+        }
+        else if (choose_mat < 0.95f) {
+            world.add(Sphere(centre, radius, Material::Metal(colour::random(rng) / 2 + vec3(.5), random_float32(rng) / 2)));
+        }
+        else {
+            world.add(Sphere(centre, radius, Material::Dielectric()));
+        }
+    }
+
+    return world;
+}
+
+// Writes the scene and camera as text so the Julia and Rust renderers can render exactly the same thing:
+//   camera lookfrom(3) lookat(3) vup(3) vfov aspect_ratio aperture focus_dist
+//   sphere centre(3) radius lambertian|metal|dielectric albedo(3) fuzz_or_ior
+// One line each, y up, in the order the spheres were added.
+void write_scene(const char* path, const HittableList& world, point3 lookfrom, point3 lookat, vec3 vup,
+                 float vfov, float aspect_ratio, float aperture, float focus_dist) {
+    std::ofstream out(path);
+    out.precision(9);
+
+    out << "camera " << lookfrom.x << ' ' << lookfrom.y << ' ' << lookfrom.z << ' '
+        << lookat.x << ' ' << lookat.y << ' ' << lookat.z << ' '
+        << vup.x << ' ' << vup.y << ' ' << vup.z << ' '
+        << vfov << ' ' << aspect_ratio << ' ' << aperture << ' ' << focus_dist << '\n';
+
+    const char* names[] = {"lambertian", "metal", "dielectric"};
+
+    for (size_t n = 0; n < world.mat.size(); n++) {
+        size_t i = n / Vec8f::size();
+        size_t j = n % Vec8f::size();
+        const Material& mat = world.mat[n];
+
+        out << "sphere " << world.centreX[i][j] << ' ' << world.centreY[i][j] << ' ' << world.centreZ[i][j] << ' ' << world.radius[i][j] << ' '
+            << names[static_cast<uint32_t>(mat.material)] << ' '
+            << mat.albedo.x << ' ' << mat.albedo.y << ' ' << mat.albedo.z << ' ' << mat.data << '\n';
+    }
+}
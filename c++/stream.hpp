@@ -0,0 +1,90 @@
+#pragma once
+
+#include "header.hpp"
+#include "colour.hpp"
+
+#include <vector>
+#include <future>
+#include <iostream>
+
+// Renders the image in bands of tile_size rows and writes each band to out as soon as it is done.
+// Only two bands are ever held in memory: one being rendered while the previous one is written.
+// A band still spans the full width because the ppm is written row by row.
+template <class SampleFn>
+void render_streaming(std::ofstream& out, int image_width, int image_height, int samples_per_pixel, int tile_size, SampleFn render_sample) {
+    const int tiles_across = (image_width + tile_size - 1) / tile_size;
+    const int band_count = (image_height + tile_size - 1) / tile_size;
+
+    std::vector<colour> bands[2] = {
+        std::vector<colour>(size_t(image_width) * tile_size),
+        std::vector<colour>(size_t(image_width) * tile_size)
+    };
+    std::future<void> writing;
+
+    std::vector<int> tileIterator;
+    for (int t = 0; t < tiles_across; ++t) {
+        tileIterator.push_back(t);
+    }
+
+    time_point<Clock> start_time = Clock::now();
+
+    // Bands go top to bottom to match the order rows are written in
+    for (int band = 0; band < band_count; ++band) {
+        const int j_top = image_height - 1 - band * tile_size;
+        const int rows = min(tile_size, j_top + 1);
+
+        std::vector<colour>& pixel = bands[band % 2];
+        std::fill(pixel.begin(), pixel.end(), colour(0, 0, 0));
+
+        auto render_tile = [&](int t) {
+#ifdef MULTITHREAD
+            thread_local RNG rng{124309};
+#else
+            static RNG rng{124309};
+#endif
+            for (int row = 0; row < rows; ++row) {
+                for (int i = t * tile_size; i < min((t + 1) * tile_size, image_width); ++i) {
+                    colour& pixel_colour = pixel[size_t(row) * image_width + i];
+
+                    for (int s = 0; s < samples_per_pixel; ++s) {
+                        pixel_colour += render_sample(i, j_top - row, s, rng);
+                    }
+                }
+            }
+        };
+
+#ifdef MULTITHREAD
+        std::for_each(std::execution::par, tileIterator.begin(), tileIterator.end(), render_tile);
+#else
+        std::for_each(tileIterator.begin(), tileIterator.end(), render_tile);
+#endif
+
+        // The other buffer is reused for the next band, so its write has to have finished
+        if (writing.valid()) {
+            writing.get();
+        }
+
+        writing = std::async(std::launch::async, [&out, &pixel, rows, image_width, samples_per_pixel] {
+            for (int row = 0; row < rows; ++row) {
+                for (int i = 0; i < image_width; ++i) {
+                    write_colour(out, pixel[size_t(row) * image_width + i], samples_per_pixel);
+                }
+            }
+            out.flush();
+        });
+
+        std::cout << "\rBands remaining: " << band_count - band - 1 << " " << std::flush;
+    }
+
+    if (writing.valid()) {
+        writing.get();
+    }
+
+    float seconds = duration_cast<milliseconds>(Clock::now() - start_time).count() / 1000.f;
+    float pixels = float(image_width) * image_height;
+
+    std::cout << "\nStreamed " << band_count << " bands of " << tile_size << " rows in " << seconds << " s: "
+              << pixels / seconds / 1e6f << " Mpixel/s, "
+              << pixels * samples_per_pixel / seconds / 1e6f << " Msamples/s, "
+              << "peak RSS " << peak_rss_bytes() / (1024 * 1024) << " MiB\n";
+}
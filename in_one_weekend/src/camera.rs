@@ -5,7 +5,10 @@ pub struct Camera {
     origin: Point3,
     lower_left_corner: Point3,
     horizontal: Vec3,
-    vertical: Vec3
+    vertical: Vec3,
+    u: Vec3,
+    v: Vec3,
+    lens_radius: N
 }
 
 impl Camera {
@@ -25,11 +28,41 @@ impl Camera {
             origin: origin,
             lower_left_corner: lower_left_corner,
             horizontal: horizontal,
-            vertical: vertical
+            vertical: vertical,
+            u: Vec3::new(1.0, 0.0, 0.0),
+            v: Vec3::new(0.0, 1.0, 0.0),
+            lens_radius: 0.0
         }
     }
 
-    pub fn get_ray(&self, u: N, v: N) -> Ray {
-        Ray::new(self.origin, self.lower_left_corner + u * self.horizontal + v * self.vertical - self.origin)
+    // Same positionable thin-lens camera as c++/camera.hpp, vfov in degrees
+    pub fn look_at(lookfrom: Point3, lookat: Point3, vup: Vec3, vfov: N, aspect_ratio: N, aperture: N, focus_dist: N) -> Camera {
+        let h = (vfov.to_radians() / 2.0).tan();
+        let viewport_height = 2.0 * h;
+        let viewport_width = aspect_ratio * viewport_height;
+
+        let w = (lookfrom - lookat).normalise();
+        let u = vup.cross(w).normalise();
+        let v = w.cross(u);
+
+        let horizontal = focus_dist * viewport_width * u;
+        let vertical = focus_dist * viewport_height * v;
+
+        Camera {
+            origin: lookfrom,
+            lower_left_corner: lookfrom - horizontal / 2.0 - vertical / 2.0 - focus_dist * w,
+            horizontal: horizontal,
+            vertical: vertical,
+            u: u,
+            v: v,
+            lens_radius: aperture / 2.0
+        }
+    }
+
+    pub fn get_ray(&self, s: N, t: N) -> Ray {
+        let rd = self.lens_radius * Vec3::random_in_unit_disk();
+        let offset = rd.x() * self.u + rd.y() * self.v;
+
+        Ray::new(self.origin + offset, self.lower_left_corner + s * self.horizontal + t * self.vertical - self.origin - offset)
     }
 }
\ No newline at end of file
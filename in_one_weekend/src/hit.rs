@@ -1,11 +1,13 @@
 use super::vec3::{Vec3, Point3, N};
 use super::ray::Ray;
 use super::sphere::Sphere;
+use super::material::Material;
 
 pub struct HitRecord {
     pub p: Point3,
     pub normal: Vec3,
-    pub t: N
+    pub t: N,
+    pub material: Material
 }
 
 pub trait Hit {
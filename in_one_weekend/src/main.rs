@@ -3,14 +3,22 @@ mod ray;
 mod hit;
 mod sphere;
 mod camera;
+mod material;
+mod scene;
 
-use vec3::{Vec3, Point3, Colour3, N};
+use vec3::{Point3, Colour3, N};
 use ray::Ray;
 use hit::{Hit, World};
 use sphere::{Sphere};
 use camera::Camera;
-
-use std::io::{stderr, Write};
+use scene::load_scene;
+
+use std::env;
+use std::fs::File;
+use std::io::{stderr, BufWriter, Write};
+use std::sync::Mutex;
+use std::thread;
+use std::time::Instant;
 use rand::Rng;
 
 fn world_colour(ray: &Ray) -> Colour3 {
@@ -19,22 +27,83 @@ fn world_colour(ray: &Ray) -> Colour3 {
     (1.0 - t) * Colour3::new(1.0, 1.0, 1.0) + t * Colour3::new(0.5, 0.7, 1.0)
 }
 
-fn ray_colour(ray: &Ray, world: &World, depth: u64) -> Colour3 {
+fn ray_colour(ray: &Ray, world: &World, depth: u64, t_min: N) -> Colour3 {
     if depth <= 0 {
         // If we've exceeded the ray bounce limit, no more light is gathered
         return Colour3::new(0.0, 0.0, 0.0);
     }
 
-    if let Some(hit_record) = world.hit(ray, 0.001, N::INFINITY) {
-        let target = hit_record.p + hit_record.normal + Vec3::random_in_unit_sphere().normalise();
-        let ray = Ray::new(hit_record.p, target - hit_record.p);
-        return 0.5 * ray_colour(&ray, world, depth - 1)
+    if let Some(hit_record) = world.hit(ray, t_min, N::INFINITY) {
+        match hit_record.material.scatter(ray, &hit_record) {
+            Some((attenuation, scattered)) => attenuation * ray_colour(&scattered, world, depth - 1, t_min),
+            None => Colour3::new(0.0, 0.0, 0.0)
+        }
     } else {
         world_colour(ray)
     }
 }
 
+// in_one_weekend scene.txt width height samples_per_pixel max_depth image.ppm
+// Renders a scene exported by the C++ renderer, for benchmark/parity.jl. Rows are shared out over one
+// thread per core, like the C++ and Julia renderers, and the image is only written once the timer stops.
+fn render_scene_file(args: &[String]) {
+    let (world, camera) = load_scene(&args[1]);
+    let image_width: u64 = args[2].parse().unwrap();
+    let image_height: u64 = args[3].parse().unwrap();
+    let samples_per_pixel: u64 = args[4].parse().unwrap();
+    let max_depth: u64 = args[5].parse().unwrap();
+
+    // Same self-intersection offset as the C++ and Julia renderers
+    const T_MIN: N = 1e-4;
+
+    let thread_count = thread::available_parallelism().map_or(1, |n| n.get());
+    println!("Threads {}", thread_count);
+
+    // Top row first, as the ppm is written
+    let mut image = vec![Colour3::new(0.0, 0.0, 0.0); (image_width * image_height) as usize];
+    let rows = Mutex::new(image.chunks_mut(image_width as usize).enumerate());
+
+    let start_time = Instant::now();
+
+    thread::scope(|scope| {
+        for _ in 0..thread_count {
+            scope.spawn(|| {
+                let mut rng = rand::thread_rng();
+
+                loop {
+                    let Some((row, pixels)) = rows.lock().unwrap().next() else { break };
+                    let j = image_height - 1 - row as u64;
+
+                    for (i, pixel_colour) in pixels.iter_mut().enumerate() {
+                        for _ in 0..samples_per_pixel {
+                            let u = ((i as N) + rng.gen::<N>()) / ((image_width - 1) as N);
+                            let v = ((j as N) + rng.gen::<N>()) / ((image_height - 1) as N);
+
+                            *pixel_colour += ray_colour(&camera.get_ray(u, v), &world, max_depth, T_MIN);
+                        }
+
+                        *pixel_colour /= samples_per_pixel as N;
+                    }
+                }
+            });
+        }
+    });
+
+    println!("Done in {} milliseconds", start_time.elapsed().as_millis());
+
+    let mut out = BufWriter::new(File::create(&args[6]).unwrap());
+    writeln!(out, "P3\n{} {}\n255", image_width, image_height).unwrap();
+    for pixel_colour in &image {
+        writeln!(out, "{}", pixel_colour.format_colour()).unwrap();
+    }
+}
+
 fn main() {
+    let args: Vec<String> = env::args().collect();
+    if args.len() > 6 {
+        return render_scene_file(&args);
+    }
+
     // Image Dimensions
     const ASPECT_RATIO: f64 = 16.0 / 9.0;
     const IMAGE_WIDTH: u64 = 256;
@@ -73,7 +142,7 @@ fn main() {
                 let v = ((j as N) + random_v)  / ((IMAGE_HEIGHT - 1) as N);
     
                 let ray = camera.get_ray(u, v);
-                pixel_colour += ray_colour(&ray, &world, MAX_DEPTH);
+                pixel_colour += ray_colour(&ray, &world, MAX_DEPTH, 0.001);
             }
 
             pixel_colour /= SAMPLES_PER_PIXEL as N;
@@ -0,0 +1,65 @@
+use super::vec3::{Vec3, Colour3, N};
+use super::ray::Ray;
+use super::hit::HitRecord;
+
+use rand::Rng;
+
+// Mirrors Material in c++/material.hpp so all renderers agree on the scene
+#[derive(Clone, Copy)]
+pub enum Material {
+    Lambertian { albedo: Colour3 },
+    Metal { albedo: Colour3, fuzz: N },
+    Dielectric { albedo: Colour3, ior: N }
+}
+
+fn reflect(v: Vec3, n: Vec3) -> Vec3 {
+    v - 2.0 * v.dot(n) * n
+}
+
+fn schlick(cos_theta: N, ior_ratio: N) -> N {
+    let r0 = ((1.0 - ior_ratio) / (1.0 + ior_ratio)).powi(2);
+    r0 + (1.0 - r0) * (1.0 - cos_theta).powi(5)
+}
+
+impl Material {
+    // Returns the attenuation and scattered ray, or None if the ray is absorbed
+    pub fn scatter(&self, ray: &Ray, rec: &HitRecord) -> Option<(Colour3, Ray)> {
+        match *self {
+            Material::Lambertian { albedo } => {
+                let target = rec.p + rec.normal + Vec3::random_in_unit_sphere().normalise();
+                Some((albedo, Ray::new(rec.p, target - rec.p)))
+            }
+            Material::Metal { albedo, fuzz } => {
+                let reflected = reflect(ray.direction().normalise(), rec.normal) + fuzz * Vec3::random_in_unit_sphere();
+                if reflected.dot(rec.normal) > 0.0 {
+                    Some((albedo, Ray::new(rec.p, reflected)))
+                } else {
+                    None
+                }
+            }
+            Material::Dielectric { albedo, ior } => {
+                let unit_direction = ray.direction().normalise();
+                let mut cos_theta = (-unit_direction.dot(rec.normal)).min(1.0);
+                let sin_theta = (1.0 - cos_theta * cos_theta).max(0.0).sqrt();
+
+                let into = cos_theta > 0.0;
+                let ior_ratio = if into { 1.0 / ior } else { ior };
+                let normal = if into { rec.normal } else { -1.0 * rec.normal };
+                if !into {
+                    cos_theta = -cos_theta;
+                }
+
+                let cannot_refract = ior_ratio * sin_theta > 1.0;
+                let direction = if cannot_refract || rand::thread_rng().gen::<N>() < schlick(cos_theta, ior_ratio) {
+                    reflect(unit_direction, normal)
+                } else {
+                    let r_out_perp = ior_ratio * (unit_direction + cos_theta * normal);
+                    let r_out_parallel = -(1.0 - r_out_perp.dot(r_out_perp)).max(0.0).sqrt() * normal;
+                    r_out_perp + r_out_parallel
+                };
+
+                Some((albedo, Ray::new(rec.p, direction)))
+            }
+        }
+    }
+}
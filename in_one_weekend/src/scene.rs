@@ -0,0 +1,45 @@
+use super::vec3::{Vec3, Point3, Colour3, N};
+use super::hit::World;
+use super::sphere::Sphere;
+use super::material::Material;
+use super::camera::Camera;
+
+use std::fs;
+
+// Loads the text scene written by the C++ renderer (see write_scene in c++/scenes.hpp)
+pub fn load_scene(path: &str) -> (World, Camera) {
+    let text = fs::read_to_string(path).unwrap_or_else(|e| panic!("Cannot read scene {}: {}", path, e));
+
+    let mut world = World::new();
+    let mut camera = None;
+
+    for line in text.lines() {
+        let mut words = line.split_whitespace();
+        let kind = match words.next() {
+            Some(kind) => kind,
+            None => continue
+        };
+        let name = if kind == "sphere" { words.clone().nth(4).unwrap_or("") } else { "" };
+        let numbers: Vec<N> = words.filter_map(|w| w.parse().ok()).collect();
+        let vec = |i: usize| Vec3::new(numbers[i], numbers[i + 1], numbers[i + 2]);
+
+        match kind {
+            "camera" => {
+                camera = Some(Camera::look_at(vec(0), vec(3), vec(6), numbers[9], numbers[10], numbers[11], numbers[12]));
+            }
+            "sphere" => {
+                let albedo: Colour3 = vec(4);
+                let material = match name {
+                    "metal" => Material::Metal { albedo, fuzz: numbers[7] },
+                    "dielectric" => Material::Dielectric { albedo, ior: numbers[7] },
+                    _ => Material::Lambertian { albedo }
+                };
+                let centre: Point3 = vec(0);
+                world.push(Sphere::with_material(centre, numbers[3], material));
+            }
+            _ => panic!("Unknown line in scene {}: {}", path, line)
+        }
+    }
+
+    (world, camera.expect("Scene has no camera line"))
+}
@@ -1,17 +1,24 @@
 use super::vec3::{Vec3, Point3, N};
 use super::ray::Ray;
 use super::hit::{Hit, HitRecord};
+use super::material::Material;
 
 pub struct Sphere {
     centre: Point3,
-    radius: N
+    radius: N,
+    material: Material
 }
 
 impl Sphere {
     pub fn new(centre: Point3, radius: N) -> Sphere {
+        Sphere::with_material(centre, radius, Material::Lambertian { albedo: Vec3::new(0.5, 0.5, 0.5) })
+    }
+
+    pub fn with_material(centre: Point3, radius: N, material: Material) -> Sphere {
         Sphere {
             centre: centre,
-            radius: radius
+            radius: radius,
+            material: material
         }
     }
 }
@@ -46,7 +53,8 @@ impl Hit for Sphere {
         let record = HitRecord {
             p: p,
             normal: (p - self.centre) / self.radius,
-            t: t
+            t: t,
+            material: self.material
         };
 
         return Some(record)
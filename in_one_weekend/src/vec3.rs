@@ -74,6 +74,17 @@ impl Vec3 {
             }
         }
     }
+
+    pub fn random_in_unit_disk() -> Vec3 {
+        let mut rng = rand::thread_rng();
+
+        loop {
+            let v = Vec3::new(rng.gen_range(-1.0..1.0), rng.gen_range(-1.0..1.0), 0.0);
+            if v.length() < 1.0 {
+                return v;
+            }
+        }
+    }
 }
 
 impl Index<usize> for Vec3 {
@@ -154,6 +165,16 @@ impl Mul<Vec3> for N {
     }
 }
 
+impl Mul<Vec3> for Vec3 {
+    type Output = Vec3;
+
+    fn mul(self, other: Vec3) -> Vec3 {
+        Vec3 {
+            e: [self[0] * other[0], self[1] * other[1], self[2] * other[2]]
+        }
+    }
+}
+
 impl Div<N> for Vec3 {
     type Output = Vec3;
 
@@ -359,11 +359,77 @@ function scene_random_spheres()
 	push!(HittableList, Sphere([-4,0,1], 1, Material.Lambertian([0.4,0.2,0.1])))
 	push!(HittableList, Sphere([4,0,1], 1, Material.Metal([0.7,0.6,0.5], 0)))
 
-    append!(HittableList, repeat([Sphere(zeros(Point), 0, Material.Lambertian())], (N - mod1(length(HittableList), N))))
-    tmp = StructArray(HittableList, unwrap = F -> (F<:AbstractVector))
+    return to_hittable_list(HittableList)
+end
+
+# Pads with empty spheres to a multiple of N and converts to the StructArray findSceneIntersection expects
+function to_hittable_list(spheres)
+    append!(spheres, repeat([Sphere(zeros(Point), 0, Material.Lambertian())], (N - mod1(length(spheres), N))))
+    tmp = StructArray(spheres, unwrap = F -> (F<:AbstractVector))
     return hittable_list(tmp);
 end
 
+# Scenes written by the c++ renderer (write_scene in c++/scenes.hpp) are y up, ours are z up
+from_y_up(x, y, z) = Point(x, -z, y)
+
+function load_scene(path)
+    spheres = Sphere[]
+    camera_parameters = nothing
+
+    for line in eachline(path)
+        words = split(line)
+        isempty(words) && continue
+
+        if words[1] == "camera"
+            # lookfrom, lookat, vup, vfov, aspect ratio, aperture, focus distance
+            camera_parameters = parse.(F, words[2:end])
+        elseif words[1] == "sphere"
+            x, y, z, radius = parse.(F, words[2:5])
+            albedo = Spectrum(parse.(F, words[7:9]))
+            data = parse(F, words[10])
+
+            if words[6] == "metal"
+                material = Material.Metal(albedo, data)
+            elseif words[6] == "dielectric"
+                material = Material.Dielectric(albedo, data)
+            else
+                material = Material.Lambertian(albedo)
+            end
+
+            push!(spheres, Sphere(from_y_up(x, y, z), radius, material))
+        else
+            error("Unknown line in scene $path: $line")
+        end
+    end
+
+    camera_parameters === nothing && error("Scene $path has no camera line")
+    return to_hittable_list(spheres), camera_parameters
+end
+
+# Maps pixels like camera::get_ray in c++/camera.hpp, so the parity renders line up pixel for pixel:
+# the viewport has the scene file's aspect ratio and samples go (i + rand) / (width - 1) across it.
+function scene_camera(nx, ny, camera_parameters)
+    c = camera_parameters
+    pinhole_location, lookat, up = from_y_up(c[1:3]...), from_y_up(c[4:6]...), from_y_up(c[7:9]...)
+    vfov, aspect_ratio, aperture, focus_distance = c[10], c[11], c[12], c[13]
+
+    camera_height = 2 * tand(vfov / 2) * focus_distance
+    camera_width = camera_height * aspect_ratio
+
+    w = normalize(lookat - pinhole_location)
+    u = normalize(w × up)
+    v = w × u
+
+    right = u * camera_width / (nx - 1)
+    down = v * camera_height / (ny - 1)
+
+    # c++ counts rows up from the bottom, (j + rand) / (height - 1), so its top row lies one step above the viewport
+    camera_centre = pinhole_location + w * focus_distance
+    upper_left_corner = camera_centre - u * camera_width / 2 - v * camera_height / 2 - down
+
+    return Camera(u, v, right, down, upper_left_corner, pinhole_location, aperture / 2)
+end
+
 @fastmath function renderRay(HittableList, maxDepth, pixel_position, camera)
     random_pixel_position = pixel_position + rand(F) * camera.right + rand(F) * camera.down
 
@@ -394,6 +460,28 @@ end
 
 spectrumToRGB(img) = map(x -> RGB(sqrt.(x)...), img)
 
+# Same tonemapping and layout as write_colour in c++/colour.hpp
+function write_ppm(path, spectrum_img)
+    open(path, "w") do io
+        print(io, "P3\n", size(spectrum_img, 2), " ", size(spectrum_img, 1), "\n255\n")
+        for i in axes(spectrum_img, 1), j in axes(spectrum_img, 2)
+            r, g, b = clamp.(floor.(Int, 256 .* sqrt.(spectrum_img[i, j])), 0, 255)
+            print(io, r, " ", g, " ", b, "\n")
+        end
+    end
+end
+
+# Renders a scene exported by the c++ renderer, used by benchmark/parity.jl. Returns the render time in seconds.
+function render_scene_file(scene_path, image_path; width=400, height=imagesize(width, 16/9)[2], samples_per_pixel=5, maxDepth=5, parallel=true)
+    scene, camera_parameters = load_scene(scene_path)
+    camera = scene_camera(width, height, camera_parameters)
+    spectrum_img = zeros(Spectrum, height, width)
+
+    seconds = @elapsed render!(spectrum_img, scene, camera; samples_per_pixel, maxDepth, parallel)
+    write_ppm(image_path, spectrum_img)
+    return seconds
+end
+
 function setup(resolution=1920/2)
     HittableList = scene_random_spheres();
     spectrum_img = zeros(Spectrum, reverse(imagesize(resolution, 16//9))...)
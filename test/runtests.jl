@@ -17,3 +17,23 @@ end
     @test_throws AssertionError Renderer.Ray(direction = Renderer.Point(0, 1, 1))
     @test_throws AssertionError Renderer.Ray(direction = Renderer.Point(0.060774088, 0.039998293, 0.8023627))
 end
+
+@testset "Scene files" begin
+    path = tempname()
+    write(path, """
+    camera 13 2 3 0 0 0 0 1 0 20 1.77777779 0.1 10
+    sphere 0 -1000 0 1000 lambertian 0.5 0.5 0.5 0
+    sphere 4 1 0 1 metal 0.7 0.6 0.5 0
+    sphere 0 1 0 1 dielectric 1 1 1 1.5
+    """)
+
+    scene, camera_parameters = Renderer.load_scene(path)
+    @test length(camera_parameters) == 13
+    @test length(scene.spheres) == Renderer.N # padded to the vector width
+    @test scene.spheres.centre[2] == Renderer.Point(4, 0, 1) # y up converted to z up
+    @test scene.spheres.material[3] isa Renderer.Material
+
+    image_path = tempname()
+    @test Renderer.render_scene_file(path, image_path; width=16, height=9, samples_per_pixel=1, maxDepth=2) >= 0
+    @test length(readlines(image_path)) == 3 + 16 * 9
+end